@@ -0,0 +1,44 @@
+#!/bin/bash
+
+# Compare two run_benchmarks.sh results as a markdown summary.
+#
+#   compare_results.sh <current results.json> [previous results.json] [title]
+#
+# Without previous results only the current ones are listed. Changes of
+# more than BENCH_THRESHOLD percent (default 5) are marked.
+
+if [ $# -lt 1 ]; then
+  echo "Usage: $0 <current results.json> [previous results.json] [title]"
+  exit 1
+fi
+
+CURRENT=$1
+PREVIOUS=$2
+TITLE=${3:-Benchmarks}
+
+if [ -z "$PREVIOUS" ] || [ ! -f "$PREVIOUS" ]; then
+    PREVIOUS=/dev/null
+fi
+
+jq -r -n --arg title "$TITLE" --argjson threshold "${BENCH_THRESHOLD:-5}" \
+    --slurpfile cur "$CURRENT" --slurpfile prev "$PREVIOUS" '
+    def delta($old; $new):
+        if $old == null then "" elif $old == 0 then ""
+        else (($new - $old) * 100 / $old) as $d
+            | "\(if $d >= 0 then "+" else "" end)\($d * 10 | round / 10)%"
+              + (if $d > $threshold then " :warning:" elif $d < -$threshold then " :rocket:" else "" end)
+        end;
+    ($cur[0]) as $c | ($prev[0] // {}) as $p
+    | "### \($title)", "",
+      "Compiler: \($c.compiler)" + (if $p.compiler and $p.compiler != $c.compiler then " (was \($p.compiler))" else "" end), "",
+      "| Compile | Wall (s) | Change | User (s) | Change | Peak RSS (MiB) |",
+      "| --- | ---: | --- | ---: | --- | ---: |",
+      ($c.compile[] | . as $s | ($p.compile // [] | map(select(.step == $s.step))[0]) as $o
+        | "| \(.step)\(if .status != 0 then " (failed)" else "" end) | \(.wall) | \(delta($o.wall; .wall)) | \(.user) | \(delta($o.user; .user)) | \(.max_rss_kb / 1024 | round) |"),
+      "",
+      "| Codegen | Bytes | Change |",
+      "| --- | ---: | --- |",
+      ($c.codegen[] | . as $g | ($p.codegen // [] | map(select(.name == $g.name))[0]) as $o
+        | "| \(.name) text | \(.text) | \(delta($o.text; .text)) |",
+          (.functions[] | . as $f | ($o.functions // [] | map(select(.name == $f.name))[0]) as $of
+            | "| \($g.name): \(.name) | \(.bytes) | \(delta($of.bytes; .bytes)) |"))'
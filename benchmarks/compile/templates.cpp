@@ -0,0 +1,129 @@
+// Template heavy C++ compile benchmark
+//
+// Only compiled, never run. Exercises what slows cc1plus down in real game
+// code: deep template recursion, variant visitation, standard containers
+// of many instantiations and constexpr evaluation.
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace bench {
+
+template<int N>
+struct Fib {
+    static constexpr long value = Fib<N - 1>::value + Fib<N - 2>::value;
+};
+
+template<>
+struct Fib<1> {
+    static constexpr long value = 1;
+};
+
+template<>
+struct Fib<0> {
+    static constexpr long value = 0;
+};
+
+constexpr long collatz(long n) {
+    long steps = 0;
+
+    while(n != 1) {
+        n = (n % 2) ? 3 * n + 1 : n / 2;
+        steps++;
+    }
+
+    return steps;
+}
+
+template<typename T, std::size_t... I>
+constexpr auto make_table(std::index_sequence<I...>) {
+    return std::array<T, sizeof...(I)>{ static_cast<T>(collatz(I + 1))... };
+}
+
+constexpr auto collatz_table = make_table<long>(std::make_index_sequence<256>{});
+
+template<int I>
+struct Component {
+    float values[4] = { I * 1.0f, I * 2.0f, I * 3.0f, I * 4.0f };
+
+    float sum() const {
+        return values[0] + values[1] + values[2] + values[3];
+    }
+};
+
+template<typename... Ts>
+struct Entity {
+    std::tuple<Ts...> components;
+
+    float sum() const {
+        return std::apply([](const auto &... c) { return (c.sum() + ...); }, components);
+    }
+};
+
+template<int... I>
+using EntityOf = Entity<Component<I>...>;
+
+using Message = std::variant<int, float, std::string, std::vector<int>,
+                             std::map<std::string, int>, std::pair<int, float>>;
+
+struct Visitor {
+    long operator()(int v) const { return v; }
+    long operator()(float v) const { return static_cast<long>(v); }
+    long operator()(const std::string &v) const { return static_cast<long>(v.size()); }
+    long operator()(const std::vector<int> &v) const { return static_cast<long>(v.size()); }
+    long operator()(const std::map<std::string, int> &v) const { return static_cast<long>(v.size()); }
+    long operator()(const std::pair<int, float> &v) const { return v.first; }
+};
+
+template<int N>
+struct Registry {
+    std::unordered_map<std::string, std::function<long(const Message &)>> handlers;
+    std::vector<std::unique_ptr<EntityOf<N, N + 1, N + 2, N + 3>>> entities;
+
+    Registry() {
+        handlers["visit" + std::to_string(N)] = [](const Message &m) {
+            return std::visit(Visitor{}, m);
+        };
+        entities.push_back(std::make_unique<EntityOf<N, N + 1, N + 2, N + 3>>());
+    }
+
+    long run(const std::vector<Message> &messages) const {
+        long total = 0;
+
+        for(const auto &m : messages)
+            for(const auto &h : handlers)
+                total += h.second(m);
+
+        for(const auto &e : entities)
+            total += static_cast<long>(e->sum());
+
+        return total;
+    }
+};
+
+template<std::size_t... I>
+long run_all(const std::vector<Message> &messages, std::index_sequence<I...>) {
+    return (Registry<static_cast<int>(I)>{}.run(messages) + ...);
+}
+
+} // namespace bench
+
+long bench_templates(const std::vector<bench::Message> &messages) {
+    std::vector<bench::Message> sorted = messages;
+
+    std::stable_sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+        return a.index() < b.index();
+    });
+
+    return bench::Fib<40>::value + bench::collatz_table[255]
+        + bench::run_all(sorted, std::make_index_sequence<48>{});
+}
@@ -0,0 +1,80 @@
+#!/bin/bash
+
+# Benchmark the toolchain of the image, compile throughput and SH4 codegen.
+#
+#   run_benchmarks.sh <output dir>
+#
+# Must be run with environ.sh sourced and KOS_CCACHE=0 so the compiler
+# itself is measured. Writes <output dir>/results.json with:
+#   compile: timed.sh results for compiling the corpus
+#     kos-kernel      the KOS kernel from scratch
+#     port-<name>     the ports in BENCH_PORTS (default zlib libpng)
+#     templates       compile/templates.cpp, template heavy C++
+#   codegen: for every program in sh4/, its text, data and bss size and
+#     the size of each bench_* function
+# Compiles use BENCH_JOBS make jobs (default 1) so the wall times compare
+# between runners. There is no SH4 emulator in the image, so the runtime
+# of the sh4/ programs isn't measured here. They print their own timings
+# when run on hardware or in an emulator.
+
+if [ $# -lt 1 ]; then
+  echo "Usage: $0 <output dir>"
+  exit 1
+fi
+
+if [ -z "$KOS_BASE" ]; then
+  echo "KOS_BASE is not set, source environ.sh first"
+  exit 1
+fi
+
+OUT=$(realpath -m "$1")
+BENCH=$(dirname "$(realpath "$0")")
+JOBS=${BENCH_JOBS:-1}
+PORTS=${BENCH_PORTS:-zlib libpng}
+
+mkdir -p "$OUT/compile" "$OUT/sh4"
+export BUILD_METRICS="$OUT/compile"
+
+# Compile throughput
+make -C "$KOS_BASE/kernel" clean > /dev/null
+timed.sh kos-kernel make -C "$KOS_BASE/kernel" -j"$JOBS" > "$OUT/kos-kernel.log" 2>&1
+
+for port in $PORTS; do
+    if [ -d "$KOS_PORTS/$port" ]; then
+        (cd "$KOS_PORTS/$port" \
+            && ${KOS_MAKE:-make} clean > /dev/null 2>&1; \
+            timed.sh port-$port ${KOS_MAKE:-make} install clean -j"$JOBS") \
+            > "$OUT/port-$port.log" 2>&1
+    fi
+done
+
+timed.sh templates kos-c++ -std=gnu++17 -O2 -c "$BENCH/compile/templates.cpp" \
+    -o "$OUT/templates.o" > "$OUT/templates.log" 2>&1
+
+# SH4 codegen
+for src in "$BENCH"/sh4/*.c; do
+    name=$(basename "$src" .c)
+    elf="$OUT/sh4/$name.elf"
+    if ! kos-cc -o "$elf" "$src" > "$OUT/sh4/$name.log" 2>&1; then
+        echo "Failed to build $name"
+        cat "$OUT/sh4/$name.log"
+        continue
+    fi
+
+    ${KOS_CC_BASE}/bin/${KOS_CC_PREFIX}-size "$elf" | awk -v name="$name" 'NR == 2 {
+        printf "{\"name\": \"%s\", \"text\": %d, \"data\": %d, \"bss\": %d}\n", name, $1, $2, $3 }' \
+        > "$OUT/sh4/$name.json"
+    ${KOS_CC_BASE}/bin/${KOS_CC_PREFIX}-nm -S -t d "$elf" | awk '$4 ~ /^_?bench_/ {
+        sub(/^_/, "", $4); printf "{\"name\": \"%s\", \"bytes\": %d}\n", $4, $2 + 0 }' \
+        | jq -s --slurpfile size "$OUT/sh4/$name.json" '$size[0] + { functions: . }' \
+        > "$OUT/sh4/$name.json.tmp"
+    mv "$OUT/sh4/$name.json.tmp" "$OUT/sh4/$name.json"
+done
+
+jq -n \
+    --arg compiler "$(${KOS_CC_BASE}/bin/${KOS_CC_PREFIX}-gcc --version | head -n 1)" \
+    --slurpfile compile <(cat "$OUT"/compile/*.json) \
+    --slurpfile codegen <(cat "$OUT"/sh4/*.json 2>/dev/null) \
+    '{ compiler: $compiler, compile: $compile, codegen: $codegen }' > "$OUT/results.json"
+
+cat "$OUT/results.json"
@@ -0,0 +1,68 @@
+/* Matrix math microbenchmark
+ *
+ * Transforms a vertex array with the XMTRX based matrix routines and with
+ * plain C, which is what the compiler's FPU code generation is measured on.
+ */
+
+#include <kos.h>
+#include <dc/matrix.h>
+#include <stdio.h>
+
+#define VERTS 4096
+#define ROUNDS 32
+
+static vector_t in[VERTS] __attribute__((aligned(32)));
+static vector_t out[VERTS] __attribute__((aligned(32)));
+
+static matrix_t mat __attribute__((aligned(32))) = {
+    { 1.0f, 0.0f, 0.0f, 0.0f },
+    { 0.0f, 0.8f, 0.6f, 0.0f },
+    { 0.0f, -0.6f, 0.8f, 0.0f },
+    { 2.0f, 3.0f, 4.0f, 1.0f }
+};
+
+__attribute__((noinline)) void bench_mat_transform(void) {
+    int i;
+
+    mat_load(&mat);
+
+    for(i = 0; i < ROUNDS; i++)
+        mat_transform(in, out, VERTS, sizeof(vector_t));
+}
+
+__attribute__((noinline)) void bench_c_transform(void) {
+    int i, v;
+
+    for(i = 0; i < ROUNDS; i++) {
+        for(v = 0; v < VERTS; v++) {
+            float x = in[v].x, y = in[v].y, z = in[v].z;
+
+            out[v].x = x * mat[0][0] + y * mat[1][0] + z * mat[2][0] + mat[3][0];
+            out[v].y = x * mat[0][1] + y * mat[1][1] + z * mat[2][1] + mat[3][1];
+            out[v].z = x * mat[0][2] + y * mat[1][2] + z * mat[2][2] + mat[3][2];
+            out[v].w = 1.0f;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    uint64_t start;
+    int v;
+
+    for(v = 0; v < VERTS; v++) {
+        in[v].x = (float)v;
+        in[v].y = (float)(v & 255);
+        in[v].z = 1.0f;
+        in[v].w = 1.0f;
+    }
+
+    start = timer_us_gettime64();
+    bench_mat_transform();
+    printf("mat_transform: %llu us\n", timer_us_gettime64() - start);
+
+    start = timer_us_gettime64();
+    bench_c_transform();
+    printf("c_transform: %llu us\n", timer_us_gettime64() - start);
+
+    return 0;
+}
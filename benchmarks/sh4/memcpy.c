@@ -0,0 +1,45 @@
+/* memcpy microbenchmark
+ *
+ * Copies between 32 byte aligned buffers with newlib's memcpy and with the
+ * store queues, the two paths games use for bulk copies.
+ */
+
+#include <kos.h>
+#include <string.h>
+#include <stdio.h>
+
+#define BUF_SIZE (64 * 1024)
+#define ROUNDS 64
+
+static uint8_t src[BUF_SIZE] __attribute__((aligned(32)));
+static uint8_t dst[BUF_SIZE] __attribute__((aligned(32)));
+
+__attribute__((noinline)) void bench_memcpy(void) {
+    int i;
+
+    for(i = 0; i < ROUNDS; i++)
+        memcpy(dst, src, BUF_SIZE);
+}
+
+__attribute__((noinline)) void bench_sq_cpy(void) {
+    int i;
+
+    for(i = 0; i < ROUNDS; i++)
+        sq_cpy(dst, src, BUF_SIZE);
+}
+
+int main(int argc, char **argv) {
+    uint64_t start;
+
+    memset(src, 0x5a, BUF_SIZE);
+
+    start = timer_us_gettime64();
+    bench_memcpy();
+    printf("memcpy: %llu us\n", timer_us_gettime64() - start);
+
+    start = timer_us_gettime64();
+    bench_sq_cpy();
+    printf("sq_cpy: %llu us\n", timer_us_gettime64() - start);
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+/* PVR submission microbenchmark
+ *
+ * Submits a strip heavy scene with direct rendering every frame, the loop
+ * most games spend their CPU time on.
+ */
+
+#include <kos.h>
+#include <stdio.h>
+
+#define STRIPS 512
+#define FRAMES 60
+
+static pvr_poly_hdr_t hdr;
+
+__attribute__((noinline)) void bench_pvr_submit(void) {
+    pvr_dr_state_t dr;
+    pvr_vertex_t *vert;
+    int s, i;
+
+    pvr_prim(&hdr, sizeof(hdr));
+    pvr_dr_init(&dr);
+
+    for(s = 0; s < STRIPS; s++) {
+        for(i = 0; i < 4; i++) {
+            vert = pvr_dr_target(dr);
+            vert->flags = i == 3 ? PVR_CMD_VERTEX_EOL : PVR_CMD_VERTEX;
+            vert->x = (float)(s & 31) * 20.0f + (i & 1) * 16.0f;
+            vert->y = (float)(s >> 5) * 30.0f + (i >> 1) * 16.0f;
+            vert->z = 1.0f;
+            vert->u = vert->v = 0.0f;
+            vert->argb = 0xff000000 | (s * 0x010101);
+            vert->oargb = 0;
+            pvr_dr_commit(vert);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    pvr_poly_cxt_t cxt;
+    uint64_t start;
+    int f;
+
+    pvr_init_defaults();
+    pvr_poly_cxt_col(&cxt, PVR_LIST_OP_POLY);
+    pvr_poly_compile(&hdr, &cxt);
+
+    start = timer_us_gettime64();
+    for(f = 0; f < FRAMES; f++) {
+        pvr_wait_ready();
+        pvr_scene_begin();
+        pvr_list_begin(PVR_LIST_OP_POLY);
+        bench_pvr_submit();
+        pvr_list_finish();
+        pvr_scene_finish();
+    }
+    printf("pvr_submit: %llu us for %d frames\n", timer_us_gettime64() - start, FRAMES);
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+#!/bin/bash
+
+# Build libkallisti and the addons once per variant in KOS_VARIANTS.
+#
+#   build_kos.sh
+#
+# Must be run from the KOS directory with environ.sh sourced. Every variant
+# is installed to lib/<arch>/variants/<variant> and can be selected with
+# KOS_LIB_VARIANT (see environ_docker.sh). release is always built last so
+# the default lib/<arch> and addons/lib/<arch> libraries are release ones.
+# Objects are shared through ccache, so only the first variant ever built
+# with a given set of flags pays for the full compile.
+#
+# Variants:
+#   release  flags from environ.sh plus KOS_RELEASE_FLAGS
+#   debug    -Og -g with frame pointers
+#   o3       -O3
+#   lto      -O3 with fat LTO objects
+
+VARIANTS=${KOS_VARIANTS:-release debug}
+
+variant_flags() {
+    case "$1" in
+      "release")
+        echo "${KOS_RELEASE_FLAGS}"
+        ;;
+      "debug")
+        echo "-Og -g -fno-omit-frame-pointer -DFRAME_POINTERS"
+        ;;
+      "o3")
+        echo "-O3"
+        ;;
+      "lto")
+        echo "-O3 -flto=auto -ffat-lto-objects"
+        ;;
+      *)
+        return 1
+        ;;
+    esac
+}
+
+set -e
+
+order=$(echo $VARIANTS | tr ' ' '\n' | grep -vx release || true)
+order="$order release"
+
+first=1
+for variant in $order; do
+    if ! flags=$(variant_flags $variant); then
+        echo "Invalid KOS variant: $variant"
+        exit 1
+    fi
+
+    echo "Building KOS ($variant)"
+    if [ $first -eq 0 ]; then
+        make -C kernel clean
+        make -C addons clean
+    fi
+    first=0
+
+    KOS_CFLAGS="${KOS_CFLAGS} $flags" make
+
+    dest=lib/${KOS_ARCH}/variants/$variant
+    mkdir -p $dest
+    cp lib/${KOS_ARCH}/*.a addons/lib/${KOS_ARCH}/*.a $dest/
+done
@@ -0,0 +1,72 @@
+#!/bin/bash
+
+# Summarize a build from its BuildKit progress and the timed.sh results.
+#
+#   build_metrics.sh <progress log> <metrics dir> [title]
+#
+# The progress log is the output of docker buildx bake --progress=rawjson,
+# lines that aren't JSON are ignored.
+# Writes <metrics dir>/stages.json (steps, cached steps and build time per
+# Dockerfile stage) and <metrics dir>/steps.json (the timed.sh results with
+# whether BuildKit took the step from the cache), and prints both as a
+# markdown summary.
+
+if [ $# -lt 2 ]; then
+  echo "Usage: $0 <progress log> <metrics dir> [title]"
+  exit 1
+fi
+
+PROGRESS=$1
+METRICS=$2
+TITLE=${3:-Build}
+
+mkdir -p "$METRICS"
+
+# Final state of every vertex. A vertex is reported several times while it
+# runs, later reports only carry the fields that changed.
+vertexes=$(jq -cR 'fromjson? | .vertexes[]?' "$PROGRESS" | jq -sc '
+    def time: if . == null then null else
+        (sub("\\.[0-9]+"; "") | fromdateiso8601)
+        + ((capture("\\.(?<f>[0-9]+)") | "0.\(.f)" | tonumber) // 0) end;
+    group_by(.digest)
+    | map(reduce .[] as $v ({}; . + ($v | with_entries(select(.value != null)))))
+    | map({
+        name,
+        stage: ((.name | capture("^\\[(?<h>[^\\]]+)\\]").h // "other")
+            | split(" ") | map(select(test("^[0-9]+/[0-9]+$") | not)) | last),
+        cached: (.cached // false),
+        error: (.error // null),
+        seconds: (if .started and .completed then
+            ((.completed | time) - (.started | time)) else 0 end)
+      })')
+
+echo "$vertexes" | jq '
+    group_by(.stage)
+    | map({
+        stage: .[0].stage,
+        steps: length,
+        cached: map(select(.cached)) | length,
+        seconds: (map(.seconds) | add * 10 | round / 10)
+      })
+    | sort_by(-.seconds)' > "$METRICS/stages.json"
+
+# timed.sh results, matched to the RUN vertex that ran the step
+cat "$METRICS"/*.json 2>/dev/null \
+    | jq -c 'select(.step?)' \
+    | jq -s --argjson vertexes "$vertexes" '
+        map(. as $step
+            | .cached = ($vertexes
+                | map(select(.name | contains("timed.sh \($step.step) ")))
+                | if length == 0 then null else all(.cached) end))
+        | sort_by(-.wall)' > "$METRICS/steps.json.tmp"
+mv "$METRICS/steps.json.tmp" "$METRICS/steps.json"
+
+echo "### $TITLE"
+echo ""
+echo "| Step | Wall (s) | User (s) | Sys (s) | Peak RSS (MiB) | Cached |"
+echo "| --- | ---: | ---: | ---: | ---: | --- |"
+jq -r '.[] | "| \(.step) | \(.wall) | \(.user) | \(.sys) | \(.max_rss_kb / 1024 | round) | \(if .cached == null then "unknown" else .cached end) |"' "$METRICS/steps.json"
+echo ""
+echo "| Stage | Steps | Cached | Build time (s) |"
+echo "| --- | ---: | ---: | ---: |"
+jq -r '.[] | "| \(.stage) | \(.steps) | \(.cached) | \(.seconds) |"' "$METRICS/stages.json"
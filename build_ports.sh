@@ -0,0 +1,146 @@
+#!/bin/bash
+
+# Build kos-ports in parallel following each port's DEPENDENCIES.
+#
+#   build_ports.sh [cache dir]
+#
+# Must be run with environ.sh sourced. A makefile with one target per port
+# is generated so independent ports build concurrently, up to make_jobs.sh
+# jobs (or MAKE_JOBS). Failed ports don't stop the others, set
+# PORTS_STRICT=1 to fail the build on any failed port.
+#
+# When a cache dir is given each installed port is stored there, keyed on the
+# port's files, the keys of its dependencies and the KOS headers and flags.
+# Ports whose key didn't change are restored instead of rebuilt.
+
+CACHE=$1
+
+# Build a single port, used by the generated makefile
+#   build_ports.sh --port <name> <key>
+if [ "$1" == "--port" ]; then
+    port=$2
+    key=$3
+    cd "${KOS_PORTS}/${port}" || exit 1
+
+    # Files installed by the port, from the kos-ports makefile variables
+    var() {
+        sed -n -e "s/^$1[[:space:]]*=[[:space:]]*//p" Makefile | head -n 1
+    }
+    name=$(var PORTNAME)
+    target=$(var TARGET)
+    hdrdir=$(var HDR_COMDIR)
+    outputs="include/${hdrdir:-$name} lib/.kos-ports/$name"
+    if [ -n "$target" ]; then
+        outputs="$outputs lib/$target"
+    fi
+
+    archive=
+    if [ -n "$PORTS_CACHE" ] && [ -n "$target" ]; then
+        archive="$PORTS_CACHE/$port-$key.tar"
+    fi
+
+    if [ -n "$archive" ] && [ -f "$archive" ]; then
+        echo "Restoring $port from cache"
+        tar -xf "$archive" -C "${KOS_PORTS}" && exit 0
+    fi
+
+    echo "Building $port"
+    ${KOS_MAKE:-make} install clean > "/tmp/kos-ports-$port.log" 2>&1
+    status=$?
+    if [ $status -ne 0 ]; then
+        echo "Failed to build $port, last lines of the log:"
+        tail -n 20 "/tmp/kos-ports-$port.log"
+        exit $status
+    fi
+
+    if [ -n "$archive" ] && [ -f "${KOS_PORTS}/lib/$target" ]; then
+        existing=
+        for out in $outputs; do
+            [ ! -e "${KOS_PORTS}/$out" ] || existing="$existing $out"
+        done
+        tar -cf "$archive.tmp" -C "${KOS_PORTS}" $existing \
+            && mv "$archive.tmp" "$archive"
+    fi
+    exit 0
+fi
+
+if [ -z "$KOS_PORTS" ]; then
+  echo "KOS_PORTS is not set, source environ.sh first"
+  exit 1
+fi
+
+SELF=$(realpath "$0")
+JOBS=$("$(dirname "$SELF")"/make_jobs.sh 2>/dev/null || nproc)
+
+cd "${KOS_PORTS}" || exit 1
+
+if [ -n "$CACHE" ]; then
+    mkdir -p "$CACHE"
+    export PORTS_CACHE=$(realpath "$CACHE")
+fi
+
+# Ports are directories with a makefile declaring PORTNAME
+ports=
+for dir in */; do
+    port=${dir%/}
+    if [ -f "$port/Makefile" ] && grep -q "^PORTNAME" "$port/Makefile"; then
+        ports="$ports $port"
+    fi
+done
+
+deps_of() {
+    sed -n -e 's/^DEPENDENCIES[[:space:]]*+*=[[:space:]]*//p' "$1/Makefile" | tr '\n' ' '
+}
+
+# Everything the ports are compiled against
+salt=$( (echo "${KOS_CFLAGS} ${KOS_CPPFLAGS}"; \
+        ${KOS_CC} --version; \
+        find "${KOS_BASE}/include" "${KOS_BASE}/kernel/arch/${KOS_ARCH}/include" \
+            "${KOS_BASE}/addons/include" -type f 2>/dev/null \
+            | LC_ALL=C sort | xargs -d '\n' cat) | sha256sum | cut -d ' ' -f 1)
+
+# Keys are computed in dependency order, a port's key covers its dependencies
+declare -A keys
+port_key() {
+    local port=$1
+    if [ -n "${keys[$port]}" ]; then
+        return
+    fi
+    keys[$port]=pending
+
+    local dep dep_keys=
+    for dep in $(deps_of "$port"); do
+        if [ -d "$dep" ]; then
+            port_key "$dep"
+            dep_keys="$dep_keys ${keys[$dep]}"
+        fi
+    done
+
+    keys[$port]=$( (echo "$salt $dep_keys"; \
+        find "$port" -type f ! -path "$port/build/*" ! -path "$port/dist/*" \
+            | LC_ALL=C sort | xargs -d '\n' sha256sum) | sha256sum | cut -d ' ' -f 1)
+}
+
+makefile=$(mktemp)
+echo "all:$ports" > "$makefile"
+for port in $ports; do
+    port_key "$port"
+    deps=
+    for dep in $(deps_of "$port"); do
+        [ ! -d "$dep" ] || deps="$deps $dep"
+    done
+    printf '%s:%s\n\t+@%s --port %s %s\n' "$port" "$deps" "$SELF" "$port" "${keys[$port]}" >> "$makefile"
+done
+echo ".PHONY: all$ports" >> "$makefile"
+
+echo "Building $(echo $ports | wc -w) ports with $JOBS jobs"
+make -k -j"$JOBS" -f "$makefile"
+status=$?
+rm -f "$makefile"
+
+if [ $status -ne 0 ]; then
+    echo "Some ports failed to build"
+    if [ "$PORTS_STRICT" == "1" ]; then
+        exit $status
+    fi
+fi
@@ -0,0 +1,34 @@
+#!/bin/bash
+
+# Run a command with the environment for a canadian cross toolchain build.
+#
+#   canadian_env.sh <command> [args]
+#
+# The toolchain is built on BUILDPLATFORM to run on TARGETPLATFORM, using
+# clang through xx as the host compiler. The bootstrap sh-elf/arm-eabi
+# toolchains built for BUILDPLATFORM are put in PATH so GCC can build the
+# target libraries (libgcc, newlib, libstdc++).
+
+if [ $# -eq 0 ]; then
+  echo "Usage: $0 <command> [args]"
+  exit 1
+fi
+
+if [ -z "$TARGETPLATFORM" ]; then
+  echo "TARGETPLATFORM must be set"
+  exit 1
+fi
+
+export PATH="/opt/bootstrap/sh-elf/bin:/opt/bootstrap/arm-eabi/bin:$PATH"
+
+export CC=xx-clang
+export CXX=xx-clang++
+export AR=llvm-ar
+export RANLIB=llvm-ranlib
+export NM=llvm-nm
+export STRIP=llvm-strip
+export OBJCOPY=llvm-objcopy
+export OBJDUMP=llvm-objdump
+export READELF=llvm-readelf
+
+exec "$@"
@@ -0,0 +1,62 @@
+#!/bin/bash
+
+# Classify changed KOS paths by what they affect.
+#
+#   git diff --name-only A B | classify_changes.sh <toolchain_inputs.txt>
+#
+# Prints "<class> <path>" for every path read from stdin:
+#   toolchain: files from toolchain_inputs.txt (any config sample)
+#   docs: documentation and examples, which the images don't build
+#   kernel: everything else, including the files under the docs paths the
+#     kos stages copy (kernel_paths)
+
+if [ $# -ne 1 ]; then
+  echo "Usage: $0 <toolchain inputs>"
+  exit 1
+fi
+
+# Manifest lines in order, like collect_toolchain_inputs.sh a later
+# exclusion overrides an earlier include and the other way around
+mapfile -t manifest < <(sed -e '/^#/d' -e '/^$/d' \
+    -e 's/\$CONFIG_FILE/config.mk.*.sample/' "$1")
+
+docs_paths="doc examples *.md README* AUTHORS LICENSE* RELNOTES* ChangeLog*"
+# environ.sh of the images is copied from the sample
+kernel_paths="doc/environ.sh.sample"
+
+matches() {
+    local file=$1 pattern patterns
+    set -f
+    patterns=($2)
+    set +f
+    for pattern in "${patterns[@]}"; do
+        if [[ "$file" == $pattern || "$file" == $pattern/* ]]; then
+            return 0
+        fi
+    done
+    return 1
+}
+
+toolchain_input() {
+    local line input=1
+    for line in "${manifest[@]}"; do
+        if [ "${line:0:1}" == "!" ]; then
+            ! matches "$1" "${line:1}" || input=1
+        else
+            ! matches "$1" "$line" || input=0
+        fi
+    done
+    return $input
+}
+
+while read -r file; do
+    if toolchain_input "$file"; then
+        echo "toolchain $file"
+    elif matches "$file" "$kernel_paths"; then
+        echo "kernel $file"
+    elif matches "$file" "$docs_paths"; then
+        echo "docs $file"
+    else
+        echo "kernel $file"
+    fi
+done
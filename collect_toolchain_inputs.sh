@@ -0,0 +1,55 @@
+#!/bin/bash
+
+# Copy the toolchain inputs listed in toolchain_inputs.txt out of a KOS tree.
+#
+#   collect_toolchain_inputs.sh <manifest> <kos dir> <output dir> <config file>
+#
+# A sha256 list of everything collected is written to
+# utils/dc-chain/toolchain-inputs.sha256 and the combined key is printed.
+
+if [ $# -ne 4 ]; then
+  echo "Usage: $0 <manifest> <kos dir> <output dir> <config file>"
+  exit 1
+fi
+
+MANIFEST=$(realpath "$1")
+SRC=$2
+DEST=$3
+CONFIG_FILE=$4
+
+SUMS=utils/dc-chain/toolchain-inputs.sha256
+
+set -e
+shopt -s nullglob
+
+mkdir -p "$DEST"
+DEST=$(realpath "$DEST")
+
+while read -r line; do
+    case "$line" in
+      ""|"#"*)
+        continue
+        ;;
+    esac
+
+    line=${line//\$CONFIG_FILE/$CONFIG_FILE}
+
+    if [ "${line:0:1}" == "!" ]; then
+        (cd "$DEST" && rm -rf -- ${line:1})
+    else
+        # Paths that don't exist in this KOS version are skipped
+        (cd "$SRC" && for path in $line; do
+            [ ! -e "$path" ] || cp -a --parents "$path" "$DEST"
+        done)
+    fi
+done < "$MANIFEST"
+
+if [ ! -f "$DEST/utils/dc-chain/$CONFIG_FILE" ]; then
+  echo "Config file $CONFIG_FILE not found in dc-chain"
+  exit 1
+fi
+
+cd "$DEST"
+find . -type f ! -path "./$SUMS" | LC_ALL=C sort | xargs -d '\n' sha256sum > "$SUMS"
+
+echo "Toolchain inputs: $(sha256sum < "$SUMS" | cut -d ' ' -f 1)"
@@ -1,31 +1,110 @@
 #!/bin/bash
 
-JOBS=$(nproc)
+# The job counts stay as they are in config.mk, every build stage passes its
+# own share (make_jobs.sh) as makejobs= on the make command line.
 
 function raw {
-    # 1. increase build core count
-    # 2. disable newlib patches
-    # 3. disable threading
+    # 1. disable newlib patches
+    # 2. disable threading
     sed -i \
-        -e "s/makejobs=-j2/makejobs=-j$JOBS/g" \
         -e '/auto_fixup_sh4_newlib/s/^#//' \
         -e "s/thread_model=kos/thread_model=single/" \
         -e '/use_kos_patches/s/^#//' \
         /opt/toolchains/dc/kos/utils/dc-chain/config.mk
 }
 
+# The sample config is used as it is
 function kos {
-    sed -i "s/makejobs=-j2/makejobs=-j$JOBS/g" \
-      /opt/toolchains/dc/kos/utils/dc-chain/config.mk
+    :
+}
+
+# kos threading with uniprocessor locking in the target libraries
+# The SH4 is uniprocessor and KOS runs in privileged mode, so the atomics
+# libstdc++ uses for shared_ptr, static-init guards and its reference counts
+# can just mask interrupts (soft-imask). sh-elf defaults to no atomic model,
+# so without it libstdc++ is configured to take a gthread mutex instead.
+# Not covered: the gthread mutexes of gthr-kos.h and the newlib locks stay
+# KOS mutexes, and __cxa_guard_* keeps libstdc++'s guard, which only locks
+# on the first initialization. There is no lock-free guard, the opt-in
+# KOS_THREADSAFE_STATICS=0 of environ_docker.sh drops the guards instead.
+# Applied after the profiles since they assign the target flags.
+function uniprocessor {
+    cat >> /opt/toolchains/dc/kos/utils/dc-chain/config.mk <<'EOF'
+
+# Uniprocessor locking, added by config_toolchain.sh
+export CFLAGS_FOR_TARGET ?= -g -O2
+export CXXFLAGS_FOR_TARGET ?= -g -O2
+CFLAGS_FOR_TARGET += -matomic-model=soft-imask
+CXXFLAGS_FOR_TARGET += -matomic-model=soft-imask
+EOF
+}
+
+# Flags the toolchain host binaries (gcc, cc1plus, as, ld...) are built with
+# 1. lto: -O2 with link time optimization
+# 2. pgo: lto plus profile guided optimization, the build selects the
+#    profile phase with pgo_phase=generate or pgo_phase=use on the make
+#    command line. Profiles are kept in /tmp/pgo.
+# lto_jobs (default auto) caps the LTO link partitions run at the same time,
+# the build stages pass make_jobs.sh --link on the make command line.
+# Passing host_cflags on the make command line replaces all of it.
+# The target libraries keep -O2, see perf for the target profile.
+function lto {
+    cat >> /opt/toolchains/dc/kos/utils/dc-chain/config.mk <<'EOF'
+
+# Host compiler flags, added by config_toolchain.sh
+lto_jobs ?= auto
+host_cflags := -O2 -flto=$(lto_jobs) -ffat-lto-objects
+ifeq ($(pgo_phase),generate)
+  host_cflags += -fprofile-generate=/tmp/pgo -fprofile-update=atomic
+endif
+ifeq ($(pgo_phase),use)
+  host_cflags += -fprofile-use=/tmp/pgo -fprofile-partial-training -Wno-missing-profile
+endif
+export CFLAGS := $(host_cflags)
+export CXXFLAGS := $(host_cflags)
+export LDFLAGS := $(host_cflags)
+export CFLAGS_FOR_TARGET := -g -O2
+export CXXFLAGS_FOR_TARGET := -g -O2
+EOF
+}
+
+# Flags the target libraries (libgcc, newlib, libstdc++) are built with
+# 1. perf: -O3. newlib's SH assembly memcpy/memset are used as long as
+#    it isn't built for size. LTO isn't used for the target libraries, GCC
+#    emits calls to libgcc and newlib functions after the LTO stage where
+#    LTO versions of them can't be resolved anymore.
+function perf {
+    cat >> /opt/toolchains/dc/kos/utils/dc-chain/config.mk <<'EOF'
+
+# Target library flags, added by config_toolchain.sh
+export CFLAGS_FOR_TARGET := -g -O3
+export CXXFLAGS_FOR_TARGET := -g -O3
+EOF
+}
+
+# Reproducible target libraries, applied after the profiles since they
+# assign the target flags. The debug info of libgcc, newlib and libstdc++
+# refers to the sources relative to dc-chain instead of the build path.
+function reproducible {
+    cat >> /opt/toolchains/dc/kos/utils/dc-chain/config.mk <<'EOF'
+
+# Reproducible builds, added by config_toolchain.sh
+export CFLAGS_FOR_TARGET ?= -g -O2
+export CXXFLAGS_FOR_TARGET ?= -g -O2
+CFLAGS_FOR_TARGET += -ffile-prefix-map=$(CURDIR)=.
+CXXFLAGS_FOR_TARGET += -ffile-prefix-map=$(CURDIR)=.
+EOF
 }
 
 if [ $# -eq 0 ]; then
   echo "Build type must be passed as first parameter"
+  echo "Host profile (default, lto or pgo) can be passed as second parameter"
+  echo "Target profile (default or perf) can be passed as third parameter"
   exit 1
 fi
 
 case "$1" in
-  "kos")
+  "kos"|"kos-up")
     kos
     ;;
   "raw")
@@ -36,3 +115,33 @@ case "$1" in
     exit 1
     ;;
 esac
+
+case "${2:-default}" in
+  "default")
+    ;;
+  "lto"|"pgo")
+    lto
+    ;;
+  *)
+    echo "Invalid Host Profile"
+    exit 1
+    ;;
+esac
+
+case "${3:-default}" in
+  "default")
+    ;;
+  "perf")
+    perf
+    ;;
+  *)
+    echo "Invalid Target Profile"
+    exit 1
+    ;;
+esac
+
+if [ "$1" == "kos-up" ]; then
+    uniprocessor
+fi
+
+reproducible
@@ -0,0 +1,349 @@
+#
+# Bake file for KallistiOS Toolchain
+#
+# Builds every stage needed for one build.json entry in a single BuildKit
+# invocation. Each stage exports its layers to its own cache scope so one
+# stage (or one arch) doesn't evict the cache of another.
+#
+
+# Values from the build.json entry, passed in as environment variables
+variable "CONFIG_FILE" {
+  default = "config.mk.stable.sample"
+}
+
+# kos, kos-up or raw, see config_toolchain.sh
+variable "BUILD_TYPE" {
+  default = "kos"
+}
+
+# native or canadian, see TOOLCHAIN_HOST in the Dockerfile
+variable "TOOLCHAIN_HOST" {
+  default = "native"
+}
+
+# default, lto or pgo, see HOST_PROFILE in the Dockerfile
+variable "HOST_PROFILE" {
+  default = "default"
+}
+
+# default or perf, see TARGET_PROFILE in the Dockerfile
+variable "TARGET_PROFILE" {
+  default = "default"
+}
+
+# Job counts, see make_jobs.sh. Empty computes them from the builder's
+# cores and memory.
+variable "MAKE_JOBS" {
+  default = ""
+}
+
+variable "MAKE_JOB_MEM" {
+  default = ""
+}
+
+variable "LINK_JOBS" {
+  default = ""
+}
+
+variable "LINK_JOB_MEM" {
+  default = ""
+}
+
+# Timestamp of the KOS commit, for reproducible images. File times and
+# image dates newer than it are clamped to it on export. The toolchain
+# targets use TOOLCHAIN_EPOCH instead, so their digests only change with
+# the toolchain.
+variable "SOURCE_DATE_EPOCH" {
+  default = "0"
+}
+
+# Fixed epoch of the toolchain images and tarball, the same as the toolchain
+# stages use (ENV SOURCE_DATE_EPOCH=0 in the Dockerfile)
+variable "TOOLCHAIN_EPOCH" {
+  default = "0"
+}
+
+# Base image, pinned by digest by the workflow
+variable "ALPINE_IMAGE" {
+  default = "ghcr.io/jitesoft/alpine"
+}
+
+variable "PLATFORM" {
+  default = "linux/amd64"
+}
+
+variable "CACHE" {
+  default = "local"
+}
+
+# KOS subarchs to build, comma separated (pristine, naomi). Every subarch
+# gets its own kos and kos-ports images on top of the same toolchain.
+variable "SUBARCHS" {
+  default = "pristine"
+}
+
+# build or image, see TOOLCHAIN_SOURCE in the Dockerfile. The kos,
+# kos-ports, metrics and benchmark targets can use a published toolchain
+# image instead of the toolchain stages.
+variable "TOOLCHAIN_SOURCE" {
+  default = "build"
+}
+
+variable "TOOLCHAIN_IMAGE" {
+  default = "toolchain"
+}
+
+# Bootstrap toolchains of canadian entries with TOOLCHAIN_SOURCE=image,
+# see the bootstrap target
+variable "BOOTSTRAP_IMAGE" {
+  default = "bootstrap-build"
+}
+
+# Image tags, the images are only pushed when their target is built
+variable "TOOLCHAIN_TAG" {
+  default = ""
+}
+
+# Extra toolchain tag for its toolchain_key.sh key, the kos only builds
+# start from the toolchain with the same key
+variable "TOOLCHAIN_KEY_TAG" {
+  default = ""
+}
+
+variable "KOS_TAG" {
+  default = ""
+}
+
+variable "PORTS_TAG" {
+  default = ""
+}
+
+# Where the stage caches are kept
+#   gha:      the Github Actions cache, shared by the whole repository
+#   registry: one cache image tag per stage in CACHE_REGISTRY
+#   local:    a directory on the runner, for persistent self-hosted runners
+variable "CACHE_BACKEND" {
+  default = "gha"
+}
+
+variable "CACHE_REGISTRY" {
+  default = "ghcr.io/cepawiel/kos-cache"
+}
+
+variable "CACHE_DIR" {
+  default = "/var/cache/buildkit"
+}
+
+# Cache import/export for one stage scope
+function "cache_from" {
+  params = [stage]
+  result = [
+    CACHE_BACKEND == "registry" ? "type=registry,ref=${CACHE_REGISTRY}:${CACHE}-${stage}" :
+    CACHE_BACKEND == "local" ? "type=local,src=${CACHE_DIR}/${CACHE}-${stage}" :
+    "type=gha,scope=${CACHE}-${stage}"
+  ]
+}
+
+function "cache_to" {
+  params = [stage]
+  result = [
+    CACHE_BACKEND == "registry" ? "type=registry,ref=${CACHE_REGISTRY}:${CACHE}-${stage},mode=max,image-manifest=true,oci-mediatypes=true" :
+    CACHE_BACKEND == "local" ? "type=local,dest=${CACHE_DIR}/${CACHE}-${stage},mode=max" :
+    "type=gha,scope=${CACHE}-${stage},mode=max"
+  ]
+}
+
+# Suffix of the tags and cache scopes of a subarch, none for pristine
+# so the Dreamcast images keep their names
+function "subarch_suffix" {
+  params = [subarch]
+  result = subarch == "pristine" ? "" : "-${subarch}"
+}
+
+group "default" {
+  targets = ["sh4", "arm", "gdb", "toolchain", "toolchain-gdb", "toolchain-slim", "debuginfo", "tarball", "kos", "ports", "kos-slim", "metrics"]
+}
+
+# Only the stages on top of the toolchain, for kernel only changes.
+# The toolchain stages come from their cache scopes.
+group "kos" {
+  targets = ["kos", "ports", "kos-slim", "metrics"]
+}
+
+target "_common" {
+  context    = "."
+  dockerfile = "Dockerfile"
+  platforms  = [PLATFORM]
+  args = {
+    CONFIG_FILE       = CONFIG_FILE
+    BUILD_TYPE        = BUILD_TYPE
+    TOOLCHAIN_HOST    = TOOLCHAIN_HOST
+    HOST_PROFILE      = HOST_PROFILE
+    TARGET_PROFILE    = TARGET_PROFILE
+    MAKE_JOBS         = MAKE_JOBS
+    MAKE_JOB_MEM      = MAKE_JOB_MEM
+    LINK_JOBS         = LINK_JOBS
+    LINK_JOB_MEM      = LINK_JOB_MEM
+    SOURCE_DATE_EPOCH = SOURCE_DATE_EPOCH
+    TOOLCHAIN_SOURCE  = TOOLCHAIN_SOURCE
+    TOOLCHAIN_IMAGE   = TOOLCHAIN_IMAGE
+    BOOTSTRAP_IMAGE   = BOOTSTRAP_IMAGE
+    ALPINE_IMAGE      = ALPINE_IMAGE
+  }
+}
+
+target "sh4" {
+  inherits   = ["_common"]
+  target     = "sh4-toolchain"
+  cache-from = cache_from("sh4")
+  cache-to   = cache_to("sh4")
+  output     = ["type=cacheonly"]
+}
+
+target "arm" {
+  inherits   = ["_common"]
+  target     = "arm-toolchain"
+  cache-from = cache_from("arm")
+  cache-to   = cache_to("arm")
+  output     = ["type=cacheonly"]
+}
+
+target "gdb" {
+  inherits   = ["_common"]
+  target     = "gdb-build"
+  cache-from = cache_from("gdb")
+  cache-to   = cache_to("gdb")
+  output     = ["type=cacheonly"]
+}
+
+# The published images. Targets built in the same invocation share the
+# layers of the stages above, so kos and ports don't rebuild the toolchain.
+target "toolchain" {
+  inherits   = ["_common"]
+  target     = "toolchain"
+  args       = { SOURCE_DATE_EPOCH = TOOLCHAIN_EPOCH }
+  cache-from = concat(cache_from("sh4"), cache_from("arm"), cache_from("toolchain"))
+  cache-to   = cache_to("toolchain")
+  tags       = compact([TOOLCHAIN_TAG, TOOLCHAIN_KEY_TAG])
+  # push and load from the same build
+  output     = ["type=image,push=true,rewrite-timestamp=true", "type=docker,rewrite-timestamp=true"]
+}
+
+# Bootstrap toolchains of canadian entries, tagged <key tag>-bootstrap.
+# Not in any group, the workflow adds it to canadian toolchain builds.
+target "bootstrap" {
+  inherits   = ["_common"]
+  target     = "bootstrap-build"
+  args       = { SOURCE_DATE_EPOCH = TOOLCHAIN_EPOCH }
+  cache-from = concat(cache_from("sh4"), cache_from("arm"))
+  tags       = ["${TOOLCHAIN_KEY_TAG}-bootstrap"]
+  output     = ["type=image,push=true,rewrite-timestamp=true"]
+}
+
+# The toolchain plus GDB, tagged <toolchain tag>-gdb
+target "toolchain-gdb" {
+  inherits   = ["_common"]
+  target     = "toolchain-gdb"
+  args       = { SOURCE_DATE_EPOCH = TOOLCHAIN_EPOCH }
+  cache-from = concat(cache_from("toolchain"), cache_from("gdb"), cache_from("toolchain-gdb"))
+  cache-to   = cache_to("toolchain-gdb")
+  tags       = ["${TOOLCHAIN_TAG}-gdb"]
+  output     = ["type=image,push=true,rewrite-timestamp=true"]
+}
+
+# The stripped toolchain on the runtime libraries only, tagged
+# <toolchain tag>-slim
+target "toolchain-slim" {
+  inherits   = ["_common"]
+  target     = "toolchain-slim"
+  args       = { SOURCE_DATE_EPOCH = TOOLCHAIN_EPOCH }
+  cache-from = concat(cache_from("toolchain"), cache_from("toolchain-slim"))
+  cache-to   = cache_to("toolchain-slim")
+  tags       = ["${TOOLCHAIN_TAG}-slim"]
+  output     = ["type=image,push=true,rewrite-timestamp=true"]
+}
+
+# Debug info split off by the strip, tagged <toolchain tag>-debuginfo
+target "debuginfo" {
+  inherits   = ["_common"]
+  target     = "toolchain-debuginfo"
+  args       = { SOURCE_DATE_EPOCH = TOOLCHAIN_EPOCH }
+  cache-from = concat(cache_from("toolchain"), cache_from("toolchain-slim"))
+  tags       = ["${TOOLCHAIN_TAG}-debuginfo"]
+  output     = ["type=image,push=true,rewrite-timestamp=true"]
+}
+
+# zstd tarball of the stripped toolchain, written to ./tarball
+target "tarball" {
+  inherits   = ["_common"]
+  target     = "toolchain-tarball"
+  args       = { SOURCE_DATE_EPOCH = TOOLCHAIN_EPOCH }
+  cache-from = concat(cache_from("toolchain"), cache_from("tarball"))
+  cache-to   = cache_to("tarball")
+  output     = ["type=local,dest=tarball"]
+}
+
+# KOS and kos-ports also need the PORTS checkout in the build context
+# One target per subarch, kos-<subarch> and ports-<subarch>. Referencing
+# kos or ports builds all of them, the toolchain stages are shared.
+target "kos" {
+  name       = "kos-${subarch}"
+  matrix     = { subarch = split(",", SUBARCHS) }
+  inherits   = ["_common"]
+  target     = "kos"
+  args       = { KOS_SUBARCH = subarch }
+  cache-from = concat(cache_from("sh4"), cache_from("arm"), cache_from("toolchain"), cache_from("kos${subarch_suffix(subarch)}"))
+  cache-to   = cache_to("kos${subarch_suffix(subarch)}")
+  tags       = ["${KOS_TAG}${subarch_suffix(subarch)}"]
+  # push and load from the same build
+  output     = ["type=image,push=true,rewrite-timestamp=true", "type=docker,rewrite-timestamp=true"]
+}
+
+target "ports" {
+  name       = "ports-${subarch}"
+  matrix     = { subarch = split(",", SUBARCHS) }
+  inherits   = ["_common"]
+  target     = "kos-ports"
+  args       = { KOS_SUBARCH = subarch }
+  cache-from = concat(cache_from("toolchain"), cache_from("kos${subarch_suffix(subarch)}"), cache_from("ports${subarch_suffix(subarch)}"))
+  cache-to   = cache_to("ports${subarch_suffix(subarch)}")
+  tags       = ["${PORTS_TAG}${subarch_suffix(subarch)}"]
+  # push and load from the same build
+  output     = ["type=image,push=true,rewrite-timestamp=true", "type=docker,rewrite-timestamp=true"]
+}
+
+# KOS on the slim toolchain, tagged <kos tag>-slim for every subarch
+target "kos-slim" {
+  name       = "kos-slim-${subarch}"
+  matrix     = { subarch = split(",", SUBARCHS) }
+  inherits   = ["_common"]
+  target     = "kos-slim"
+  args       = { KOS_SUBARCH = subarch }
+  cache-from = concat(cache_from("toolchain"), cache_from("toolchain-slim"), cache_from("kos${subarch_suffix(subarch)}"), cache_from("kos-slim${subarch_suffix(subarch)}"))
+  cache-to   = cache_to("kos-slim${subarch_suffix(subarch)}")
+  tags       = ["${KOS_TAG}-slim${subarch_suffix(subarch)}"]
+  output     = ["type=image,push=true,rewrite-timestamp=true"]
+}
+
+# timed.sh results of every stage, written to ./metrics
+# KOS and kos-ports are measured for the first subarch
+target "metrics" {
+  inherits   = ["_common"]
+  target     = "metrics"
+  args       = { KOS_SUBARCH = split(",", SUBARCHS)[0] }
+  cache-from = concat(cache_from("sh4"), cache_from("arm"), cache_from("gdb"), cache_from("toolchain"), cache_from("kos${subarch_suffix(split(",", SUBARCHS)[0])}"), cache_from("ports${subarch_suffix(split(",", SUBARCHS)[0])}"), cache_from("metrics"))
+  cache-to   = cache_to("metrics")
+  output     = ["type=local,dest=metrics"]
+}
+
+# Toolchain benchmarks of the first subarch, written to ./benchmark
+# Not in any group, the workflow bakes it on its own after the other
+# targets so the timings don't share the builder with them.
+target "benchmark" {
+  inherits   = ["_common"]
+  target     = "benchmark"
+  args       = { KOS_SUBARCH = split(",", SUBARCHS)[0] }
+  cache-from = concat(cache_from("toolchain"), cache_from("kos${subarch_suffix(split(",", SUBARCHS)[0])}"), cache_from("ports${subarch_suffix(split(",", SUBARCHS)[0])}"), cache_from("benchmark"))
+  cache-to   = cache_to("benchmark")
+  output     = ["type=local,dest=benchmark"]
+}
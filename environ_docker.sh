@@ -0,0 +1,53 @@
+# Container specific additions to environ.sh
+# This file is sourced at the end of environ.sh inside the container.
+
+# Wrap the sh-elf and arm-eabi compilers in ccache.
+# The compiler names in /opt/toolchains/dc/ccache/bin link to ccache, which
+# runs the real compiler from CCACHE_PATH. Mount a volume on CCACHE_DIR to
+# keep the cache between container runs, for example:
+#   docker run --rm -v kos-ccache:/var/cache/ccache $TAG "make"
+# Set KOS_CCACHE=0 to use the compilers directly.
+if [ "${KOS_CCACHE:-1}" != "0" ] && [ -d /opt/toolchains/dc/ccache/bin ]; then
+    export CCACHE_PATH="${KOS_CC_BASE}/bin:${DC_ARM_BASE}/bin"
+    export KOS_CC="/opt/toolchains/dc/ccache/bin/${KOS_CC_PREFIX}-gcc"
+    export KOS_CCPLUS="/opt/toolchains/dc/ccache/bin/${KOS_CC_PREFIX}-g++"
+    export DC_ARM_CC="/opt/toolchains/dc/ccache/bin/${DC_ARM_PREFIX}-gcc"
+fi
+
+# Link against a libkallisti variant built by build_kos.sh
+# (lib/<arch>/variants), for example KOS_LIB_VARIANT=debug.
+# Unset or release uses the default libraries.
+if [ -n "${KOS_LIB_VARIANT}" ] && [ "${KOS_LIB_VARIANT}" != "release" ]; then
+    if [ -d "${KOS_BASE}/lib/${KOS_ARCH}/variants/${KOS_LIB_VARIANT}" ]; then
+        export KOS_LDFLAGS="-L${KOS_BASE}/lib/${KOS_ARCH}/variants/${KOS_LIB_VARIANT} ${KOS_LDFLAGS}"
+    else
+        echo "KOS library variant ${KOS_LIB_VARIANT} is not available" >&2
+    fi
+fi
+
+# Toolchains built with BUILD_TYPE=kos-up have target libraries using the
+# soft-imask atomic model, programs and libkallisti use it as well.
+# With kos-up, KOS_THREADSAFE_STATICS=0 also drops the guards around the
+# initialization of function local statics in C++ (-fno-threadsafe-statics).
+# This is not a lock-free guard, there is no guard left at all. Only safe
+# for programs that never initialize them from more than one thread.
+if [ "$(cat /opt/toolchains/dc/.toolchain-type 2>/dev/null)" == "kos-up" ]; then
+    export KOS_CFLAGS="${KOS_CFLAGS} -matomic-model=soft-imask"
+    if [ "${KOS_THREADSAFE_STATICS:-1}" == "0" ]; then
+        echo "KOS_THREADSAFE_STATICS=0: static locals must only be initialized from one thread" >&2
+        export KOS_CPPFLAGS="${KOS_CPPFLAGS} -fno-threadsafe-statics"
+    fi
+elif [ "${KOS_THREADSAFE_STATICS:-1}" == "0" ]; then
+    echo "KOS_THREADSAFE_STATICS=0 needs a kos-up toolchain, ignored" >&2
+fi
+
+# KOS is built for one subarch (KOS_SUBARCH build arg), building for
+# another one with these libraries doesn't work
+if [ -f "${KOS_BASE}/.kos-subarch" ]; then
+    kos_built_subarch=$(cat "${KOS_BASE}/.kos-subarch")
+    if [ "${KOS_SUBARCH}" != "${kos_built_subarch}" ]; then
+        echo "KOS_SUBARCH is ${KOS_SUBARCH} but KOS was built for ${kos_built_subarch}," \
+            "use the ${KOS_SUBARCH} image instead" >&2
+    fi
+    unset kos_built_subarch
+fi
@@ -0,0 +1,83 @@
+#!/bin/bash
+
+# Run the dc-chain fetch step with a persistent download cache.
+#
+#   fetch_sources.sh <cache dir> [make targets]
+#
+# Must be run from the dc-chain directory after config.mk is set up.
+# Tarballs for the versions in config.mk are restored from the cache before
+# running make (fetch by default), so dc-chain only downloads what is missing.
+# New downloads are added to the cache afterwards. Every tarball is checked
+# against the sha256 recorded when it was first downloaded, broken cache
+# entries are dropped and downloaded again.
+#
+# The toolchain stages fetch only their own components, for example
+#   FETCH_VARS='^arm_' fetch_sources.sh <cache dir> fetch-arm-binutils fetch-arm-gcc
+# FETCH_VARS is a regex for the config.mk version variables whose tarballs
+# are restored (default all of them). dc-chain versions without the per
+# component targets fetch everything.
+
+if [ $# -eq 0 ]; then
+  echo "Usage: $0 <cache dir> [make targets]"
+  exit 1
+fi
+
+CACHE=$1
+shift
+TARGETS=${@:-fetch}
+
+SUMS=$CACHE/SHA256SUMS
+
+set -e
+shopt -s nullglob
+
+mkdir -p "$CACHE"
+touch "$SUMS"
+
+# sha256 recorded for a tarball, empty if unknown
+recorded_sum() {
+    awk -v f="$1" '$2 == f { print $1 }' "$SUMS" | tail -n 1
+}
+
+# Versions of the components selected in config.mk
+versions=$(sed -n -e 's/^\([a-z_]*_ver=[^ #]*\).*/\1/p' config.mk \
+    | grep -E -e "${FETCH_VARS:-.}" | cut -d = -f 2 | sort -u)
+
+for ver in $versions; do
+    for cached in "$CACHE"/*-"$ver".tar.*; do
+        name=$(basename "$cached")
+        if [ "$(sha256sum < "$cached" | cut -d ' ' -f 1)" != "$(recorded_sum "$name")" ]; then
+            echo "Dropping corrupt cached source $name"
+            rm -f "$cached"
+            continue
+        fi
+        if [ ! -f "$name" ]; then
+            echo "Using cached source $name"
+            cp "$cached" "$name"
+        fi
+    done
+done
+
+if [ "$TARGETS" != "fetch" ] && ! make -n $TARGETS > /dev/null 2>&1; then
+    echo "No $TARGETS in this dc-chain, fetching everything"
+    TARGETS=fetch
+fi
+
+make $TARGETS -j4
+
+for tarball in *.tar.*; do
+    sum=$(sha256sum < "$tarball" | cut -d ' ' -f 1)
+    recorded=$(recorded_sum "$tarball")
+
+    if [ -z "$recorded" ]; then
+        cp "$tarball" "$CACHE/$tarball"
+        echo "$sum  $tarball" >> "$SUMS"
+    elif [ "$sum" == "$recorded" ]; then
+        [ -f "$CACHE/$tarball" ] || cp "$tarball" "$CACHE/$tarball"
+    else
+        echo "Checksum mismatch for $tarball"
+        echo "Expected: $recorded"
+        echo "Got:      $sum"
+        exit 1
+    fi
+done
@@ -0,0 +1,74 @@
+#!/bin/bash
+
+# Generate the build matrix for a sync from build.json.
+#
+#   generate_matrix.sh <build.json> <toolchains.json> <toolchain inputs> [changed files]
+#
+# Every entry gets a toolchain field with the tag of its toolchains.json
+# entry (same config, target_profile and build_type), and a targets field with the bake
+# targets to build:
+#   default: the toolchain and everything on top of it
+#   kos: only the stages on top of the (cached) toolchain
+# Changed files are classified with classify_changes.sh. A changed config
+# sample only rebuilds the toolchains.json entries using it, any other
+# toolchain input rebuilds every toolchain. Entries not affected by any
+# change are left out. Without a changed files list everything is built.
+
+if [ $# -lt 3 ]; then
+  echo "Usage: $0 <build.json> <toolchains.json> <toolchain inputs> [changed files]"
+  exit 1
+fi
+
+BUILD_CONFIG=$1
+TOOLCHAINS=$2
+TOOLCHAIN_INPUTS=$3
+CHANGES=$4
+
+# toolchains.json tag of every entry
+tagged() {
+    jq -c --slurpfile toolchains "$TOOLCHAINS" '
+        [.[] | . as $entry
+            | .toolchain = ([$toolchains[0][]
+                | select(.config == $entry.config
+                    and (.target_profile // "default") == ($entry.target_profile // "default")
+                    and (.build_type // "kos") == ($entry.build_type // "kos"))
+                | .tag][0] // null)]'
+}
+
+if [ -z "$CHANGES" ] || [ ! -f "$CHANGES" ]; then
+    jq -c '[.[] | .targets = "default"]' "$BUILD_CONFIG" | tagged
+    exit 0
+fi
+
+classes=$("$(dirname "$0")"/classify_changes.sh "$TOOLCHAIN_INPUTS" < "$CHANGES")
+
+# Configs whose toolchain changed, "*" for all of them
+configs=$(echo "$classes" | awk '$1 == "toolchain" { print $2 }' | while read -r file; do
+    case "$file" in
+      utils/dc-chain/config.mk.*.sample)
+        basename "$file"
+        ;;
+      *)
+        echo "*"
+        ;;
+    esac
+done | sort -u | jq -R . | jq -sc .)
+
+kernel=false
+if echo "$classes" | grep -q "^kernel "; then
+    kernel=true
+fi
+
+# Samples not used by any toolchain in toolchains.json don't rebuild anything
+jq -c --argjson configs "$configs" --argjson kernel $kernel \
+    --slurpfile toolchains "$TOOLCHAINS" '
+    ($toolchains[0] | map(.config) + ["*"]) as $known
+    | ($configs | map(select(. as $c | $known | index($c)))) as $configs
+    | [.[]
+        | if ($configs | index("*")) or (.config as $c | $configs | index($c)) then
+            .targets = "default"
+          elif $kernel then
+            .targets = "kos"
+          else
+            empty
+          end]' "$BUILD_CONFIG" | tagged
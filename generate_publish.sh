@@ -0,0 +1,50 @@
+#!/bin/bash
+
+# Generate the list of multi-arch manifests to publish for a build matrix.
+#
+#   generate_publish.sh <publish.json> <toolchains.json> <build matrix>
+#
+# publish.json lists the published images and the build.json field holding
+# the per-arch image they are made of. Every image gets one manifest per
+# toolchains.json entry, tagged with the entry's tag (and latest for the
+# default toolchain), pointing at the images of every arch built with that
+# entry's config, target_profile and build_type. Manifests without any built image are
+# left out.
+#
+# Images marked with subarch get one manifest per subarch of the
+# toolchains.json entry (subarchs, default pristine). Their tags and
+# per-arch images get a -<subarch> suffix, except for pristine.
+#
+# src_suffix is appended to the per-arch images of an image, for images
+# tagged after another build.json field (<toolchain_tag>-gdb).
+
+if [ $# -lt 3 ]; then
+  echo "Usage: $0 <publish.json> <toolchains.json> <build matrix>"
+  exit 1
+fi
+
+PUBLISH_CONFIG=$1
+TOOLCHAINS=$2
+MATRIX=$3
+
+jq -c --slurpfile toolchains "$TOOLCHAINS" --slurpfile matrix "$MATRIX" '
+    def suffix: if . == "pristine" then "" else "-\(.)" end;
+    [.[] as $image
+        | $toolchains[0][]
+        | . as $toolchain
+        | (if $image.subarch then ($toolchain.subarchs // ["pristine"])[] else "pristine" end)
+        | . as $subarch
+        | {
+            name: $image.name,
+            tags: ([$toolchain.tag] + (if $toolchain.default then ["latest"] else [] end)
+                | map(. + ($subarch | suffix))),
+            src: [$matrix[0][]
+                | select(.config == $toolchain.config
+                    and (.target_profile // "default") == ($toolchain.target_profile // "default")
+                    and (.build_type // "kos") == ($toolchain.build_type // "kos")
+                    and ((.subarchs // "pristine") | split(",") | index($subarch)))
+                | .[$image.src] // empty
+                | . + ($image.src_suffix // "")
+                | . + ($subarch | suffix)]
+          }
+        | select(.src | length > 0)]' "$PUBLISH_CONFIG"
@@ -0,0 +1,64 @@
+#!/bin/bash
+
+# Print the make job count for a single toolchain build stage.
+#
+# BuildKit runs the sh4-toolchain, arm-toolchain and gdb-build stages in
+# parallel, so each stage is only given its share of the machine:
+#
+#   make_jobs.sh [--link] [--balanced] [percent of machine] [memory per job in MB]
+#
+# The result is limited by both available cores and available memory and
+# never drops below 1. Setting MAKE_JOBS skips the calculation entirely.
+#
+# The shares are static, a stage keeps its share after the other stages
+# finished. With --balanced the share only limits the memory and the job
+# count may use every core. The caller adds make -l$(nproc), the load
+# average is shared by all containers, so the stages running at the same
+# time split the cores between them and the last one running gets all of
+# them.
+#
+# --link gives the job count for link heavy steps instead, the LTO link
+# partitions (-flto=N). Those need far more memory per job, LINK_JOB_MEM
+# (default 2048) is used unless a memory per job is passed and LINK_JOBS
+# skips the calculation.
+
+MEM_DEFAULT=${MAKE_JOB_MEM:-1024}
+FIXED=$MAKE_JOBS
+if [ "$1" == "--link" ]; then
+    shift
+    MEM_DEFAULT=${LINK_JOB_MEM:-2048}
+    FIXED=$LINK_JOBS
+fi
+
+CORE_SHARE=
+if [ "$1" == "--balanced" ]; then
+    shift
+    CORE_SHARE=100
+fi
+
+if [ -n "$FIXED" ]; then
+    echo "$FIXED"
+    exit 0
+fi
+
+SHARE=${1:-100}
+JOB_MEM=${2:-$MEM_DEFAULT}
+CORE_SHARE=${CORE_SHARE:-$SHARE}
+
+cores=$(nproc)
+mem=$(awk '/^MemAvailable:/ { print int($2 / 1024) }' /proc/meminfo)
+
+jobs=$(( cores * CORE_SHARE / 100 ))
+
+if [ -n "$mem" ]; then
+    mem_jobs=$(( mem * SHARE / 100 / JOB_MEM ))
+    if [ $mem_jobs -lt $jobs ]; then
+        jobs=$mem_jobs
+    fi
+fi
+
+if [ $jobs -lt 1 ]; then
+    jobs=1
+fi
+
+echo $jobs
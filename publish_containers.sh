@@ -0,0 +1,47 @@
+#!/bin/bash
+
+# Publish the multi-arch manifests listed by generate_publish.sh.
+#
+#   publish_containers.sh <publish list>
+#
+# The manifests are created in the registry with docker buildx imagetools,
+# nothing is pulled locally. All of them are pushed at the same time and
+# each push is retried a few times (PUBLISH_RETRIES, default 3).
+
+if [ $# -lt 1 ]; then
+  echo "Usage: $0 <publish list>"
+  exit 1
+fi
+
+RETRIES=${PUBLISH_RETRIES:-3}
+
+publish() {
+    local manifest=$1
+    local name=$(echo "$manifest" | jq -r .name)
+    local args=$(echo "$manifest" | jq -r --arg name "$name" \
+        '(.tags[] | "-t", "\($name):\(.)"), .src[]')
+
+    local try
+    for try in $(seq $RETRIES); do
+        echo "Publishing $name (attempt $try):" $args
+        if docker buildx imagetools create $args; then
+            return 0
+        fi
+        sleep $((try * 10))
+    done
+
+    echo "Failed to publish $name"
+    return 1
+}
+
+pids=
+while read -r manifest; do
+    publish "$manifest" &
+    pids="$pids $!"
+done < <(jq -c '.[]' "$1")
+
+status=0
+for pid in $pids; do
+    wait $pid || status=1
+done
+exit $status
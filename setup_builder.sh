@@ -0,0 +1,43 @@
+#!/bin/bash
+
+# Select a long-lived BuildKit builder on a self-hosted runner.
+#
+#   setup_builder.sh <name> <buildkitd.toml>
+#
+# The builder is created with the docker-container driver the first time
+# and reused by every later job on the runner, so its local layer cache
+# survives between builds and the remote cache is only used on a miss.
+# The buildkitd config it was created with is kept in BUILDER_STATE
+# (default ~/.cache/kos-builder). When the config changes the builder is
+# created again, keeping its state volume and so its cache.
+
+if [ $# -lt 2 ]; then
+  echo "Usage: $0 <name> <buildkitd.toml>"
+  exit 1
+fi
+
+NAME=$1
+CONFIG=$2
+STATE=${BUILDER_STATE:-$HOME/.cache/kos-builder}
+
+set -e
+
+mkdir -p "$STATE"
+
+if docker buildx inspect "$NAME" > /dev/null 2>&1 \
+    && cmp -s "$CONFIG" "$STATE/$NAME.toml"; then
+    echo "Reusing builder $NAME"
+else
+    if docker buildx inspect "$NAME" > /dev/null 2>&1; then
+        echo "Builder config changed, recreating $NAME"
+        docker buildx rm --keep-state "$NAME"
+    fi
+    echo "Creating builder $NAME"
+    docker buildx create --name "$NAME" --driver docker-container \
+        --buildkitd-config "$CONFIG"
+    cp "$CONFIG" "$STATE/$NAME.toml"
+fi
+
+docker buildx use "$NAME"
+docker buildx inspect --bootstrap "$NAME"
+docker buildx du --builder "$NAME" | tail -n 3
@@ -0,0 +1,42 @@
+#!/bin/bash
+
+# Strip the host binaries of an installed toolchain.
+#
+#   strip_toolchain.sh <toolchain prefix> <debug root>
+#
+# Debug info of every host executable and shared library is split into
+# <debug root><path>.debug and linked back with a gnu-debuglink, so gdb
+# finds it when the debug root is /usr/lib/debug. Target (sh-elf/arm-eabi)
+# objects and libraries can't be read by the host binutils and are left as is.
+
+if [ $# -ne 2 ]; then
+  echo "Usage: $0 <toolchain prefix> <debug root>"
+  exit 1
+fi
+
+PREFIX=$1
+DEBUG_ROOT=$2
+
+find "$PREFIX" -type f \( -perm -u+x -o -name "*.so*" \) | while read -r file; do
+    # Only ELF files
+    [ "$(head -c 4 "$file")" == $'\177ELF' ] || continue
+
+    debug="$DEBUG_ROOT$file.debug"
+    mkdir -p "$(dirname "$debug")"
+
+    # Fails for target binaries which the host objcopy doesn't support
+    objcopy --only-keep-debug "$file" "$debug" 2>/dev/null || {
+        rm -f "$debug"
+        continue
+    }
+
+    case "$file" in
+      *.so*)
+        strip --strip-unneeded "$file"
+        ;;
+      *)
+        strip --strip-all "$file"
+        ;;
+    esac
+    objcopy --remove-section=.gnu_debuglink --add-gnu-debuglink="$debug" "$file"
+done
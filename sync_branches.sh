@@ -5,10 +5,26 @@ DIR=builder
 WORKFLOW=../build_workflow.yml
 BUILD_CONFIG=../build.json
 PUBLISH_CONFIG=../publish.json
+TOOLCHAIN_INPUTS=../toolchain_inputs.txt
+CLASSIFY=../classify_changes.sh
+
+# Number of branches pushed at the same time
+SYNC_JOBS=${SYNC_JOBS:-4}
+
+# Branches pushed before the others (space separated globs). The other
+# branches are only pushed once the build jobs of these have left the
+# queue, or after SYNC_PRIORITY_WAIT seconds. Waiting needs the gh cli
+# logged in (GH_TOKEN), without it the push order is only a hint to the
+# runner queue.
+SYNC_PRIORITY=${SYNC_PRIORITY:-master stable*}
+SYNC_PRIORITY_WAIT=${SYNC_PRIORITY_WAIT:-900}
 
 
 cd $DIR
 
+# Last built sync of every branch, tagged by the build workflow
+git fetch --quiet origin '+refs/tags/built/*:refs/tags/built/*' || true
+
 echo ''
 all_branches=$(git branch -r | sed -e '/origin\/HEAD -> /d')
 
@@ -31,19 +47,37 @@ echo -e "Starting...\n\n"
 # All new branches need to be synced
 sync_list=$new_branches
 
-checksync() {
-    local commits_behind=$(git rev-list --count origin/$1..upstream/$1)
-    local commits_ahead=$(git rev-list --count upstream/$1..origin/$1)
+# Read every ref needed for the comparisons in one go.
+# A synced branch is exactly one commit (ours) on top of upstream, so it is
+# up to date when the parent of origin/<branch> is upstream/<branch>.
+declare -A origin_parent upstream_tip built_parent
+readrefs() {
+    origin_parent=()
+    upstream_tip=()
+    built_parent=()
+    while read -r br parent; do
+        origin_parent[$br]=$parent
+    done < <(git for-each-ref --format='%(refname:lstrip=3) %(parent)' refs/remotes/origin)
+    while read -r br parent; do
+        built_parent[$br]=$parent
+    done < <(git for-each-ref --format='%(refname:lstrip=3) %(parent)' refs/tags/built)
+    while read -r br tip; do
+        upstream_tip[$br]=$tip
+    done < <(git for-each-ref --format='%(refname:lstrip=3) %(objectname)' refs/remotes/upstream)
+}
 
-    if [ "$commits_ahead" == "1" ] && [ "$commits_behind" == "0" ]
+checksync() {
+    if [ "${origin_parent[$1]}" == "${upstream_tip[$1]}" ]
     then
-        echo "$br is up to date!"
+        echo "$1 is up to date!"
     else
-        echo "$br needs syncing (Behind: $commits_behind, Ahead: $commits_ahead)"
-        sync_list=$(echo "$br ${sync_list[@]}")
+        echo "$1 needs syncing (Upstream: ${upstream_tip[$1]:0:12}, Synced: ${origin_parent[$1]:0:12})"
+        sync_list=$(echo "$1 ${sync_list[@]}")
     fi
 }
 
+readrefs
+
 # Check to see which existing branches need to be synced
 for br in $update_branches
 do
@@ -55,18 +89,46 @@ do
     echo "TODO: Old - $old"
 done
 
+# Label which parts of KOS changed since the last sync so the build
+# workflow can skip or shorten its matrix (Sync-Changes trailer).
+# The classes are toolchain, kernel and docs (see classify_changes.sh),
+# or all for new or diverged branches with nothing to compare against.
+# Changes are counted from the last built sync (built/<branch>), the syncs
+# pushed after it may never have been built.
+classify() {
+    local from=$1 to=$2
+    if [ -z "$from" ] || ! git merge-base --is-ancestor $from $to 2>/dev/null; then
+        echo "all"
+        return
+    fi
+
+    git diff --name-only $from $to | $CLASSIFY $TOOLCHAIN_INPUTS \
+        | cut -d ' ' -f 1 | sort -u | paste -sd, -
+}
+
+# The sync commit is created without checking out the branch, from the
+# upstream tree plus our workflow and config files
+workflow_blob=$(git hash-object -w $WORKFLOW)
+build_blob=$(git hash-object -w $BUILD_CONFIG)
+publish_blob=$(git hash-object -w $PUBLISH_CONFIG)
+
 dosync() {
     echo "Syncing upstream/$1 to origin/$1"
-    git checkout -B $1 upstream/$1
-    mkdir -p .github/workflows
-    cp $WORKFLOW .github/workflows/build.yml
-    git add .github/workflows/build.yml
-    cp $BUILD_CONFIG build.json
-    cp $PUBLISH_CONFIG publish.json
-    git add build.json
-    git add publish.json
-    git commit -m "Setup Github Actions"
-    git push --force -u origin $1
+    local changes=$(classify "${built_parent[$1]}" upstream/$1)
+    echo "Changes: $changes"
+
+    local index=$(mktemp -u)
+    GIT_INDEX_FILE=$index git read-tree upstream/$1
+    GIT_INDEX_FILE=$index git update-index --add \
+        --cacheinfo 100644,$workflow_blob,.github/workflows/build.yml \
+        --cacheinfo 100644,$build_blob,build.json \
+        --cacheinfo 100644,$publish_blob,publish.json
+    local tree=$(GIT_INDEX_FILE=$index git write-tree)
+    rm -f $index
+
+    local commit=$(git commit-tree $tree -p upstream/$1 \
+        -m "Setup Github Actions" -m "Sync-Changes: ${changes:-none}")
+    git update-ref refs/heads/$1 $commit
 }
 
 for sync in $sync_list
@@ -74,9 +136,70 @@ do
     dosync $sync
 done
 
+# Push the synced branches concurrently, the priority branches first
+read -ra priority_patterns <<< "$SYNC_PRIORITY"
+priority_list=
+other_list=
+for br in $sync_list
+do
+    list=other_list
+    for pattern in "${priority_patterns[@]}"
+    do
+        if [[ $br == $pattern ]]; then
+            list=priority_list
+        fi
+    done
+    printf -v $list '%s %s' "${!list}" "$br"
+done
+
+pushbranches() {
+    echo $@ | tr ' ' '\n' | sed '/^$/d' \
+        | xargs -r -P $SYNC_JOBS -I{} git push --force origin refs/heads/{}:refs/heads/{}
+}
+
+# A build run has claimed its runners once none of its build_matrix jobs
+# are queued, runs that finished or build nothing count as well
+runclaimed() {
+    local sha=$(git rev-parse refs/heads/$1)
+    local id=$(gh run list --workflow build.yml --commit $sha --limit 1 \
+        --json databaseId --jq '.[0].databaseId // empty')
+    [ -n "$id" ] || return 1
+    gh run view $id --json status,jobs --jq '
+        .status == "completed"
+        or ([.jobs[] | select(.name | startswith("build_matrix"))] as $builds
+            | ($builds | length) > 0 and all($builds[]; .status != "queued"))' \
+        | grep -q true
+}
+
+prioritywait() {
+    local deadline=$((SECONDS + SYNC_PRIORITY_WAIT)) br
+    for br in $@
+    do
+        until runclaimed $br || [ $SECONDS -ge $deadline ]
+        do
+            sleep 15
+        done
+        echo "$br: $(runclaimed $br && echo "building" || echo "still queued")"
+    done
+}
+
+echo "Priority Branches:" $priority_list
+pushbranches $priority_list
+if [ -n "$priority_list" ] && [ -n "$other_list" ]; then
+    if command -v gh > /dev/null && gh auth status > /dev/null 2>&1; then
+        echo "Waiting for the priority builds to start"
+        prioritywait $priority_list
+    else
+        echo "gh isn't logged in, not waiting for the priority builds"
+    fi
+fi
+pushbranches $other_list
+
+readrefs
+
 test_list=$(echo "$sync_list")
 echo $test_list
 for branch in $test_list
 do
     checksync $branch
-done
\ No newline at end of file
+done
@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# Run a build step and record what it cost.
+#
+#   timed.sh <step> <command> [args]
+#
+# Wall, user and system time (seconds) and the peak RSS of the largest
+# process (KiB) are written as JSON to $BUILD_METRICS/<step>.json
+# (default /var/log/build-metrics). The metrics stage in the Dockerfile
+# collects these files from every stage.
+
+if [ $# -lt 2 ]; then
+  echo "Usage: $0 <step> <command> [args]"
+  exit 1
+fi
+
+STEP=$1
+shift
+
+DIR=${BUILD_METRICS:-/var/log/build-metrics}
+mkdir -p "$DIR"
+
+# /usr/bin/time (busybox), not the bash keyword
+/usr/bin/time -o "$DIR/$STEP.time" \
+    -f '"wall": %e, "user": %U, "sys": %S, "max_rss_kb": %M' "$@"
+status=$?
+
+echo "{\"step\": \"$STEP\", $(tail -n 1 "$DIR/$STEP.time"), \"status\": $status}" > "$DIR/$STEP.json"
+rm -f "$DIR/$STEP.time"
+exit $status
@@ -0,0 +1,36 @@
+#!/bin/bash
+
+# Print the cache key of a toolchain build.
+#
+#   toolchain_key.sh <kos dir> <config file>
+#
+# Covers the toolchain inputs of the KOS tree (collect_toolchain_inputs.sh),
+# the build scripts the toolchain stages use and the settings they are
+# built with (PLATFORM, BUILD_TYPE, TOOLCHAIN_HOST, HOST_PROFILE and
+# TARGET_PROFILE from the environment), and the corpus the pgo profile is
+# trained on. Toolchains with the same key are
+# identical, so a published toolchain can be reused when its key matches.
+
+if [ $# -lt 2 ]; then
+  echo "Usage: $0 <kos dir> <config file>"
+  exit 1
+fi
+
+DIR=$(dirname "$(realpath "$0")")
+KOS=$1
+CONFIG_FILE=$2
+
+set -e -o pipefail
+
+inputs=$(mktemp -d)
+trap 'rm -rf "$inputs"' EXIT
+
+"$DIR"/collect_toolchain_inputs.sh "$DIR"/toolchain_inputs.txt "$KOS" "$inputs" \
+    "$CONFIG_FILE" > /dev/null
+
+(cat "$inputs/utils/dc-chain/toolchain-inputs.sha256"; \
+    echo "${PLATFORM} ${BUILD_TYPE:-kos} ${TOOLCHAIN_HOST:-native}" \
+        "${HOST_PROFILE:-default} ${TARGET_PROFILE:-default}"; \
+    cd "$DIR" && sha256sum Dockerfile config_toolchain.sh fetch_sources.sh \
+        make_jobs.sh canadian_env.sh timed.sh benchmarks/compile/*) \
+    | sha256sum | cut -d ' ' -f 1